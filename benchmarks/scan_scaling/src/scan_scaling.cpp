@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 LaffeyNyaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <inline_html/exception.h>
+#include <inline_html/inline_html.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static const std::string BENCH_PATH = "res/large.html";
+static constexpr size_t DEFAULT_SIZE_MB = 64;
+static constexpr int RUNS = 3;
+
+static void write_document(const size_t size) {
+    const std::string block =
+        "<div class=\"row\">\r\n"
+        "    <p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p>\r\n"
+        "    <!-- <link rel=\"stylesheet\" href=\"style.css\"> -->\r\n"
+        "</div>\r\n";
+    const std::string tags =
+        "<link rel=\"stylesheet\" href=\"style.css\">\r\n"
+        "<script src=\"script.js\"></script>\r\n";
+
+    std::ofstream file(BENCH_PATH, std::ios::binary);
+    size_t written = 0;
+
+    for (size_t i = 0; written < size; ++i) {
+        const auto &chunk = i % 64 == 0 ? tags : block;
+        file << chunk;
+        written += chunk.size();
+    }
+}
+
+/**
+ * Usage: scan_scaling [size in MiB] [max threads]
+ */
+int main(int argc, char *argv[]) {
+    const size_t size_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                    : DEFAULT_SIZE_MB;
+    const unsigned int max_threads =
+        argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10))
+                 : std::max(std::thread::hardware_concurrency(), 1u);
+
+    write_document(size_mb * 1024 * 1024);
+    std::cout << "threads\tbest ms\tspeedup\n";
+
+    double baseline = 0;
+
+    try {
+        for (unsigned int threads = 1; threads <= max_threads; ++threads) {
+            double best = 0;
+
+            for (int run = 0; run < RUNS; ++run) {
+                const auto start = std::chrono::steady_clock::now();
+                const auto html_data =
+                    inline_html::inline_html(BENCH_PATH, {.threads = threads});
+                const std::chrono::duration<double, std::milli> elapsed =
+                    std::chrono::steady_clock::now() - start;
+
+                if (run == 0 || elapsed.count() < best) {
+                    best = elapsed.count();
+                }
+            }
+
+            if (threads == 1) {
+                baseline = best;
+            }
+
+            std::cout << threads << "\t" << best << "\t" << baseline / best
+                      << "\n";
+        }
+    } catch (const inline_html::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -35,6 +35,35 @@ namespace inline_html {
 
 using res_map = std::map<std::string, int>;
 
+/**
+ * @brief Options controlling how an HTML document is inlined.
+ */
+struct options {
+    /**
+     * @brief The number of threads used to scan the document for tags and to
+     * strip carriage returns. `0` selects the hardware concurrency. Documents
+     * too small to be worth splitting are always processed on one thread.
+     */
+    unsigned int threads = 0;
+
+    /**
+     * @brief Whether to bundle `<script type="module" src="">` files.
+     *
+     * When enabled, the static `import` and `export ... from` declarations
+     * with relative specifiers are resolved starting from the script's
+     * directory. Every module is read once, and all of them are emitted in
+     * dependency order into the single inlined `<script>`. Each module runs in
+     * its own function scope and hands its exports to its importers, so their
+     * top-level names may repeat. Imports of absolute URLs are hoisted to the
+     * top of the script. Only applies to documents read from files.
+     *
+     * Imported names are bound once, to the values exported after the
+     * imported module ran, rather than being live bindings. A module that
+     * reassigns one of its exported names is therefore rejected.
+     */
+    bool bundle_modules = false;
+};
+
 /**
  * @brief Inlines external CSS and JS files into an HTML document.
  *
@@ -44,12 +73,14 @@ using res_map = std::map<std::string, int>;
  * blocks respectively.
  *
  * @param path The file file_path to the HTML document to process.
+ * @param opts The options controlling the inlining.
  *
  * @return std::string The processed HTML document with CSS and JS inlined.
  *
  * @throws inline_html::exception
  */
-std::string inline_html(const std::string_view path);
+std::string inline_html(const std::string_view path,
+                        const options &opts = {});
 
 #ifdef _WIN32
 /**
@@ -63,11 +94,13 @@ std::string inline_html(const std::string_view path);
  * @param id The resource ID of the HTML document to process.
  * @param map A mapping of resource filenames to their corresponding
  *                resource IDs for CSS and JS files.
+ * @param opts The options controlling the inlining.
  *
  * @return std::string The processed HTML document with CSS and JS inlined.
  *
  * @throws inline_html::exception
  */
-std::string inline_html(const int id, const res_map &map);
+std::string inline_html(const int id, const res_map &map,
+                        const options &opts = {});
 #endif  // _WIN32
 }  // namespace inline_html
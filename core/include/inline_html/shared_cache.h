@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 LaffeyNyaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#ifndef _WIN32
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "inline_html/inline_html.h"
+
+namespace inline_html {
+
+/**
+ * @brief A cache of inlined documents shared between processes through a
+ * POSIX shared memory segment.
+ *
+ * Every entry is stored under a key, together with a hash of the state of
+ * its dependencies and the list of those dependencies. Lookups never take a
+ * lock: every slot of the index is guarded by a sequence counter. Writers are
+ * serialized by a robust process-shared mutex. When a process dies while
+ * holding it, the next writer discards the entries left half-written. While
+ * an `entry` is alive its slot is pinned, so its data is never evicted. The
+ * pins of dead processes are released when a writer runs out of space. Once
+ * the capacity is exhausted, the least recently used unpinned entries are
+ * evicted.
+ *
+ * Each process must open the cache itself, after any `fork()`.
+ */
+class shared_cache {
+   public:
+    /**
+     * @brief A cached document, pinned in the shared segment until it is
+     * destroyed. Must not outlive the `shared_cache` it comes from.
+     */
+    class entry {
+       public:
+        /**
+         * @brief Wraps a document that could not be stored in the cache.
+         */
+        explicit entry(std::string data) noexcept;
+
+        entry(entry &&other) noexcept;
+        entry &operator=(entry &&other) noexcept;
+        ~entry();
+
+        /**
+         * @brief The inlined document, read-only.
+         */
+        std::string_view view() const noexcept;
+
+        /**
+         * @brief The dependencies stored along with the document.
+         */
+        std::string_view dependencies() const noexcept;
+
+        /**
+         * @brief The hash of the dependencies stored along with the document.
+         */
+        std::uint64_t dep_hash() const noexcept;
+
+        /**
+         * @brief Whether the document lives in the shared segment.
+         */
+        bool shared() const noexcept;
+
+       private:
+        friend class shared_cache;
+
+        entry(shared_cache *cache, size_t slot, std::uint64_t dep_hash,
+              std::string_view dependencies, std::string_view view) noexcept;
+
+        void release() noexcept;
+
+        shared_cache *cache_ = nullptr;
+        size_t slot_ = 0;
+        std::uint64_t dep_hash_ = 0;
+        std::string_view dependencies_;
+        std::string_view view_;
+        std::string owned_;
+    };
+
+    /**
+     * @brief Opens the shared memory segment `name`, creating it if it does
+     * not exist yet. An existing segment keeps its own size.
+     *
+     * @param name The name of the segment, e.g. `/inline_html`.
+     * @param capacity The number of bytes available for documents.
+     * @param slots The maximum number of documents.
+     *
+     * @throws inline_html::exception
+     */
+    shared_cache(const std::string_view name, const size_t capacity,
+                 const size_t slots = 1024);
+
+    shared_cache(const shared_cache &) = delete;
+    shared_cache &operator=(const shared_cache &) = delete;
+    ~shared_cache();
+
+    /**
+     * @brief Looks up the latest document stored under `key`.
+     */
+    std::optional<entry> find(const std::string_view key);
+
+    /**
+     * @brief Stores `data` under `key`, replacing the entries of `key` with
+     * another `dep_hash`. Those still held are only hidden from `find` until
+     * they are released.
+     *
+     * @return std::optional<entry> The stored entry, or nothing if `data`
+     * does not fit, or every entry in its way is pinned.
+     */
+    std::optional<entry> insert(const std::string_view key,
+                                const std::uint64_t dep_hash,
+                                const std::string_view dependencies,
+                                const std::string_view data);
+
+    /**
+     * @brief Removes the shared memory segment `name`. Processes that still
+     * have it open keep their mapping.
+     */
+    static void remove(const std::string_view name) noexcept;
+
+    /**
+     * @brief The 64-bit FNV-1a hash of `data`, chained from `seed`. Stable
+     * across processes.
+     */
+    static std::uint64_t hash(
+        const std::string_view data,
+        const std::uint64_t seed = 0xcbf29ce484222325) noexcept;
+
+   private:
+    struct header;
+    struct slot;
+
+    slot &get_slot(const size_t index) const noexcept;
+    entry get_entry(const size_t index) noexcept;
+    char *get_data() const noexcept;
+    const char *get_read_only_data() const noexcept;
+    void pin(const size_t index) noexcept;
+    void unpin(const size_t index) noexcept;
+    bool pinned(const size_t index) const noexcept;
+    bool lock() noexcept;
+    void unlock() noexcept;
+    void recover() noexcept;
+    void reap_processes() noexcept;
+    bool evict(const size_t index) noexcept;
+    void supersede(const size_t index) noexcept;
+    std::optional<size_t> allocate(const size_t size,
+                                   const size_t target) noexcept;
+
+    void *mapping_ = nullptr;
+    const void *read_only_mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    size_t process_ = 0;
+    header *header_ = nullptr;
+    std::mutex pins_mutex_;
+    std::vector<std::uint32_t> pins_;
+};
+
+/**
+ * @brief Inlines an HTML document through a shared cache.
+ *
+ * Documents are stored under their canonical path and the options changing
+ * the output, along with the files they were built from: the document, its
+ * stylesheets and scripts, and any bundled modules. A cached document is only
+ * returned while the size and modification time of each of those files are
+ * unchanged, which is checked without reading them. Otherwise the document is
+ * inlined again and stored, unless one of those files changed while it was
+ * being read.
+ *
+ * @param path The file path to the HTML document to process.
+ * @param cache The cache to look up and store the document in.
+ * @param opts The options controlling the inlining.
+ *
+ * @return shared_cache::entry The processed HTML document with CSS and JS
+ * inlined.
+ *
+ * @throws inline_html::exception
+ */
+shared_cache::entry inline_html(const std::string_view path,
+                                shared_cache &cache, const options &opts = {});
+}  // namespace inline_html
+
+#endif  // _WIN32
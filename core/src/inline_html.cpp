@@ -24,15 +24,40 @@
 
 #include "inline_html/inline_html.h"
 
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <regex>
+#include <set>
+#include <thread>
 #include <vector>
 
 #include "inline_html/exception.h"
+#include "inline_html/shared_cache.h"
 
 namespace inline_html {
-using smatches = std::vector<std::smatch>;
+struct tag_match {
+    size_t position;
+    std::smatch groups;
+};
+
+using tag_matches = std::vector<tag_match>;
+
+struct file_stats {
+    std::uint64_t size;
+    std::uint64_t time;
+};
+
+/**
+ * @brief A file read while inlining a document.
+ */
+struct dependency {
+    std::string path;
+    file_stats stats;
+};
 
 static const std::string STYLE_PATTERN =
     R"(<link([^>]*?)rel=["']stylesheet["']([^>]*?)href=["']([^"']*)["']([^>]*?)>)";
@@ -40,6 +65,27 @@ static const std::string SCRIPT_PATTERN =
     R"(<script([^>]*?)src=["']([^"']*)["']([^>]*?)>(.*)</script>)";
 static const std::string STYLE_TAG = "style";
 static const std::string SCRIPT_TAG = "script";
+static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+static const std::string MODULE_TYPE_PATTERN =
+    R"(type\s*=\s*["']module["'])";
+static const std::string IMPORT_PATTERN =
+    R"((^|[\n;}])([ \t]*)import\s*(?:([\w$*{},\s]+?)\s*from\s*)?["']([^"'\n]+)["'])";
+static const std::string NAME_PATTERN = R"(([\w$]+)(?:\s+as\s+([\w$]+))?)";
+static const std::string NAMESPACE_PATTERN = R"(\*\s*as\s+([\w$]+))";
+static const std::string EXPORT_FROM_PATTERN =
+    R"((^|[\n;}])([ \t]*)export\s*(\*(?:\s*as\s+[\w$]+)?|\{[^}]*\})\s*from\s*["']([^"'\n]+)["'])";
+static const std::string EXPORT_LIST_PATTERN =
+    R"((^|[\n;}])([ \t]*)export\s*\{([^}]*)\}(?!\s*from\b))";
+static const std::string EXPORT_DEFAULT_DECL_PATTERN =
+    R"((^|[\n;}])([ \t]*)export\s+default\s+((?:async\s+)?function\b\s*\*?\s*([\w$]+)(?=\s*\()|class\s+(?!extends\b)([\w$]+)\b))";
+static const std::string EXPORT_DEFAULT_PATTERN =
+    R"((^|[\n;}])([ \t]*)export\s+default\b\s*)";
+static const std::string EXPORT_DECL_PATTERN =
+    R"((^|[\n;}])([ \t]*)export\s+((?:async\s+)?function\b\s*\*?\s*|class\s+|(?:const|let|var)\s+)([\w$]+))";
+static const std::string EXPORT_PATTERN = R"((^|[\n;}])[ \t]*export\b)";
+static const std::string ASSIGNMENT_PATTERN =
+    R"((^|[^\w$.])([\w$]+)\s*((?:[-+*/%&|^]|\*\*|<<|>>>?|&&|\|\||\?\?)?=(?![=>])|\+\+|--)|(\+\+|--)\s*([\w$]+))";
 
 static std::string get_dir(const std::string_view path) noexcept {
     const auto pos = path.find_last_of("/\\");
@@ -61,6 +107,27 @@ static std::string read_file(const std::string_view path) {
     return std::string(std::istreambuf_iterator<char>(file), {});
 }
 
+static file_stats get_stats(const std::string_view path) noexcept {
+    const std::filesystem::path file(path);
+    std::error_code ec;
+    const auto time = std::filesystem::last_write_time(file, ec);
+
+    return {std::filesystem::file_size(file, ec),
+            static_cast<std::uint64_t>(time.time_since_epoch().count())};
+}
+
+/**
+ * @brief Reads `path` and appends it to `dependencies`, with the stats it had
+ * before being read.
+ *
+ * @throws std::ios::failure
+ */
+static std::string read_dependency(const std::string &path,
+                                   std::vector<dependency> &dependencies) {
+    dependencies.push_back({path, get_stats(path)});
+    return read_file(path);
+}
+
 #ifdef _WIN32
 /**
  * @throws std::system_error
@@ -99,30 +166,705 @@ static std::string read_res(const int32_t id, LPCSTR type) {
 }
 #endif  // _WIN32
 
-static smatches get_smatches(const std::string &data,
-                             const std::string_view pattern) noexcept {
+/**
+ * @brief Splits `size` bytes into at most `threads` contiguous chunks of at
+ * least `MIN_CHUNK_SIZE` bytes each.
+ *
+ * @return std::vector<size_t> The chunk bounds, starting with `0` and ending
+ * with `size`.
+ */
+static std::vector<size_t> get_chunk_bounds(const size_t size,
+                                            unsigned int threads) noexcept {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    const auto count = std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, threads);
+    std::vector<size_t> bounds(count + 1);
+
+    for (size_t i = 0; i <= count; ++i) {
+        bounds[i] = size / count * i + std::min(size % count, i);
+    }
+
+    return bounds;
+}
+
+/**
+ * @brief Runs `func(0)` ... `func(count - 1)`, each on its own thread.
+ *
+ * An exception thrown by `func` is rethrown here once every thread joined,
+ * as it would be if the chunks ran one after another.
+ *
+ * @throws std::system_error
+ */
+template <typename Func>
+static void run_chunks(const size_t count, Func &&func) {
+    std::vector<std::exception_ptr> errors(count);
+
+    const auto run = [&](const size_t i) {
+        try {
+            func(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(count - 1);
+
+        for (size_t i = 1; i < count; ++i) {
+            workers.emplace_back(run, i);
+        }
+
+        run(0);
+    }
+
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * @brief Collects the matches of `regex` starting in `[begin, end)`.
+ *
+ * A match may extend past `end`. Every match starts with `<`, so the regex
+ * is only tried at those positions, which yields the same matches as
+ * `std::sregex_iterator` starting at `begin`.
+ */
+static tag_matches scan_chunk(const std::string &data, const std::regex &regex,
+                              const size_t begin, const size_t end) {
+    tag_matches matches;
+    auto pos = data.find('<', begin);
+
+    while (pos < end) {
+        std::smatch groups;
+
+        if (std::regex_search(data.begin() + pos, data.end(), groups, regex,
+                              std::regex_constants::match_continuous)) {
+            const auto len = static_cast<size_t>(groups.length(0));
+            matches.push_back({pos, std::move(groups)});
+            pos = data.find('<', pos + len);
+        } else {
+            pos = data.find('<', pos + 1);
+        }
+    }
+
+    return matches;
+}
+
+/**
+ * @brief Scans the chunks of `data` in parallel and merges them in order.
+ *
+ * A match found in one chunk may run into the next one, e.g. a tag split by
+ * the chunk boundary or a `<script>` body spanning it. When that happens the
+ * next chunk is rescanned from the end of that match, so the result is
+ * identical to a sequential scan.
+ *
+ * @throws std::system_error
+ */
+static tag_matches get_matches(const std::string &data,
+                               const std::string_view pattern,
+                               const unsigned int threads) {
     const std::regex regex(pattern.data(), std::regex_constants::icase);
+    const auto bounds = get_chunk_bounds(data.size(), threads);
+    const auto count = bounds.size() - 1;
+    std::vector<tag_matches> partials(count);
+
+    run_chunks(count, [&](const size_t i) {
+        partials[i] = scan_chunk(data, regex, bounds[i], bounds[i + 1]);
+    });
+
+    tag_matches matches = std::move(partials[0]);
+
+    for (size_t i = 1; i < count; ++i) {
+        size_t cursor = bounds[i];
+
+        if (!matches.empty()) {
+            const auto &last = matches.back();
+            const auto last_end =
+                last.position + static_cast<size_t>(last.groups.length(0));
+            cursor = std::max(cursor, last_end);
+        }
+
+        auto &partial = partials[i];
+
+        if (!partial.empty() && partial.front().position < cursor) {
+            partial = scan_chunk(data, regex, cursor, bounds[i + 1]);
+        }
+
+        std::move(partial.begin(), partial.end(), std::back_inserter(matches));
+    }
+
+    return matches;
+}
+
+struct module_graph {
+    std::map<std::string, std::string> sources;
+    std::set<std::string> visited;
+    std::vector<std::string> stack;
+    std::vector<std::string> order;
+};
+
+/**
+ * @brief Replaces every match of `regex` in `source` with `func(match)`.
+ */
+template <typename Func>
+static std::string replace_matches(const std::string &source,
+                                   const std::regex &regex, Func &&func) {
+    std::string result;
+    size_t last = 0;
+
+    for (std::sregex_iterator iter(source.begin(), source.end(), regex), end;
+         iter != end; ++iter) {
+        const auto pos = static_cast<size_t>(iter->position());
+        result.append(source, last, pos - last);
+        result.append(func(*iter));
+        last = pos + static_cast<size_t>(iter->length());
+    }
+
+    result.append(source, last);
+    return result;
+}
+
+static std::string trim(const std::string_view str) noexcept {
+    const auto first = str.find_first_not_of(" \t\r\n");
+
+    if (first == std::string_view::npos) {
+        return "";
+    }
+
+    const auto last = str.find_last_not_of(" \t\r\n");
+    return std::string(str.substr(first, last - first + 1));
+}
+
+/**
+ * @brief Resolves the module specifier `spec` imported by `importer`.
+ *
+ * @return std::string The normalized path of the imported module, or an
+ * empty string if `spec` is an absolute URL that is left to the browser.
+ *
+ * @throws exception
+ */
+static std::string resolve_module(const std::string_view importer,
+                                  const std::string &spec) {
+    if (spec.find("://") != std::string::npos) {
+        return "";
+    }
+
+    if (!spec.starts_with("./") && !spec.starts_with("../")) {
+        throw exception("Unresolvable module specifier: \"" + spec +
+                        "\" imported from " + std::string(importer));
+    }
+
+    const auto dir = std::filesystem::path(importer).parent_path();
+    const auto path = (dir / spec).lexically_normal();
+
+    std::error_code ec;
+
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        throw exception("Failed to resolve module: \"" + spec +
+                        "\" imported from " + std::string(importer) +
+                        (ec ? "\nSystem error: " + ec.message() : ""));
+    }
+
+    return path.generic_string();
+}
+
+/**
+ * @brief Reads `path` and the modules it imports, and appends them to
+ * `graph.order` after their dependencies.
+ *
+ * @throws exception
+ */
+static void visit_module(const std::string &path, module_graph &graph,
+                         std::vector<dependency> &dependencies) {
+    const auto on_stack =
+        std::find(graph.stack.begin(), graph.stack.end(), path);
+
+    if (on_stack != graph.stack.end()) {
+        std::string cycle;
+
+        for (auto iter = on_stack; iter != graph.stack.end(); ++iter) {
+            cycle += *iter + " -> ";
+        }
+
+        throw exception("Circular module import: " + cycle + path);
+    }
+
+    if (graph.visited.contains(path)) {
+        return;
+    }
+
+    std::string source;
+
+    try {
+        source = read_dependency(path, dependencies);
+    } catch (const std::ios::failure &) {
+        throw exception("Failed to read file: " + path);
+    }
+
+    graph.stack.push_back(path);
+
+    for (const auto &pattern : {IMPORT_PATTERN, EXPORT_FROM_PATTERN}) {
+        const std::regex regex(pattern);
+
+        for (std::sregex_iterator iter(source.begin(), source.end(), regex),
+             end;
+             iter != end; ++iter) {
+            const auto dep = resolve_module(path, (*iter)[4].str());
+
+            if (!dep.empty()) {
+                visit_module(dep, graph, dependencies);
+            }
+        }
+    }
+
+    graph.stack.pop_back();
+    graph.visited.insert(path);
+    graph.order.push_back(path);
+    graph.sources.emplace(path, std::move(source));
+}
+
+struct js_module {
+    std::string name;
+    std::vector<std::string> exports;
+};
+
+using js_exports = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Returns the expression reading the export `imported` of the module
+ * whose exports are held by `name`.
+ *
+ * @param names The names exported by that module, or `nullptr` if they are
+ * unknown because it is loaded by the browser.
+ *
+ * @throws exception
+ */
+static std::string get_export(const std::string &name,
+                              const std::vector<std::string> *names,
+                              const std::string &imported,
+                              const std::string_view path) {
+    if (names != nullptr &&
+        std::find(names->begin(), names->end(), imported) == names->end()) {
+        throw exception("Module does not export \"" + imported +
+                        "\": imported from " + std::string(path));
+    }
+
+    return name + "." + imported;
+}
+
+/**
+ * @brief Turns an import clause into the declarations binding its local
+ * names to the exports held by `name`.
+ *
+ * @throws exception
+ */
+static std::string bind_imports(const std::string &clause,
+                                const std::string &name,
+                                const std::vector<std::string> *names,
+                                const std::string_view path) {
+    std::string bindings;
+    const auto star = clause.find('*');
+    const auto brace = clause.find('{');
+    const auto default_binding = trim(std::string_view(clause).substr(
+        0, std::min({star, brace, clause.find(',')})));
+
+    if (!default_binding.empty()) {
+        bindings += "const " + default_binding + " = " +
+                    get_export(name, names, "default", path) + ";";
+    }
+
+    if (star != std::string::npos) {
+        const std::regex namespace_regex(NAMESPACE_PATTERN);
+        std::smatch match;
+
+        if (std::regex_search(clause, match, namespace_regex)) {
+            bindings += "const " + match[1].str() + " = " + name + ";";
+        }
+    }
+
+    if (brace == std::string::npos) {
+        return bindings;
+    }
+
+    const auto list =
+        clause.substr(brace + 1, clause.find('}', brace) - brace - 1);
+    const std::regex name_regex(NAME_PATTERN);
+
+    for (std::sregex_iterator iter(list.begin(), list.end(), name_regex), end;
+         iter != end; ++iter) {
+        const auto imported = (*iter)[1].str();
+        const auto local = (*iter)[2].matched ? (*iter)[2].str() : imported;
+        bindings += "const " + local + " = " +
+                    get_export(name, names, imported, path) + ";";
+    }
+
+    return bindings;
+}
+
+static bool is_name_char(const char c) noexcept {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+           c == '$';
+}
+
+/**
+ * @brief Returns the names declared after the first one by the `const`,
+ * `let` or `var` declaration continuing with `rest`, e.g. `b` and `c` for
+ * `a = 1, b = [1, 2], c;`.
+ *
+ * @throws exception If one of them is a destructuring pattern.
+ */
+static std::vector<std::string> get_declarators(const std::string_view rest,
+                                                const std::string_view path) {
+    static constexpr std::string_view CONTINUATIONS = ",=+-*/%&|^!?:<>.([";
+    std::vector<std::string> names;
+    int depth = 0;
+    char last = '\0';
+
+    for (size_t i = 0; i < rest.size(); ++i) {
+        const auto c = rest[i];
+
+        if (c == '"' || c == '\'' || c == '`') {
+            while (++i < rest.size() && rest[i] != c) {
+                i += rest[i] == '\\';
+            }
+        } else if (rest.substr(i, 2) == "//") {
+            i = std::min(rest.find('\n', i), rest.size()) - 1;
+            continue;
+        } else if (rest.substr(i, 2) == "/*") {
+            i = std::min(rest.find("*/", i + 2), rest.size() - 1) + 1;
+            continue;
+        } else if (c == '(' || c == '[' || c == '{') {
+            ++depth;
+        } else if (c == ')' || c == ']' || c == '}') {
+            if (--depth < 0) {
+                break;
+            }
+        } else if (depth == 0 && c == ';') {
+            break;
+        } else if (depth == 0 && c == '\n') {
+            // Without a `;`, the declaration ends with the first line break
+            // that neither the line before nor the line after continues.
+            const auto next = rest.find_first_not_of(" \t\r\n", i);
+
+            if (CONTINUATIONS.find(last) == std::string_view::npos &&
+                (next == std::string_view::npos ||
+                 CONTINUATIONS.find(rest[next]) == std::string_view::npos)) {
+                break;
+            }
+        } else if (depth == 0 && c == ',') {
+            auto begin = rest.find_first_not_of(" \t\r\n", i + 1);
+            begin = begin == std::string_view::npos ? rest.size() : begin;
+            auto end = begin;
+
+            while (end < rest.size() && is_name_char(rest[end])) {
+                ++end;
+            }
+
+            if (end == begin) {
+                throw exception("Unsupported export declaration: " +
+                                std::string(path));
+            }
+
+            names.emplace_back(rest.substr(begin, end - begin));
+            i = end - 1;
+            last = rest[i];
+            continue;
+        }
+
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            last = c;
+        }
+    }
+
+    return names;
+}
+
+/**
+ * @brief Whether the name at `pos` in `source` is declared there, i.e.
+ * follows `const`, `let`, `var` or another declarator.
+ */
+static bool is_declaration(const std::string_view source,
+                           const size_t pos) noexcept {
+    auto end = pos;
+
+    while (end > 0 &&
+           std::isspace(static_cast<unsigned char>(source[end - 1]))) {
+        --end;
+    }
+
+    if (end > 0 && source[end - 1] == ',') {
+        return true;
+    }
+
+    auto begin = end;
+
+    while (begin > 0 && is_name_char(source[begin - 1])) {
+        --begin;
+    }
+
+    const auto word = source.substr(begin, end - begin);
+    return word == "const" || word == "let" || word == "var";
+}
+
+/**
+ * @brief Rejects a module reassigning one of its exported names, as the
+ * declarations binding them in its importers would not follow.
+ *
+ * @throws exception
+ */
+static void check_reassignments(const std::string &source,
+                                const js_exports &exports,
+                                const std::string_view path) {
+    static const std::regex assignment_regex(ASSIGNMENT_PATTERN);
 
-    return smatches(std::sregex_iterator(data.begin(), data.end(), regex), {});
+    for (std::sregex_iterator iter(source.begin(), source.end(),
+                                   assignment_regex),
+         end;
+         iter != end; ++iter) {
+        const auto &match = *iter;
+        const auto name = match[2].matched ? match[2].str() : match[5].str();
+        const auto exported = std::any_of(
+            exports.begin(), exports.end(),
+            [&](const auto &entry) { return entry.second == name; });
+
+        // The initializer of its own declaration is not a reassignment.
+        if (!exported ||
+            (match[3].str() == "=" &&
+             is_declaration(source, match.position(2)))) {
+            continue;
+        }
+
+        throw exception("Exported binding \"" + name +
+                        "\" is reassigned, which bundled imports cannot "
+                        "follow: " +
+                        std::string(path));
+    }
 }
 
 /**
+ * @brief Bundles the ES module at `path` and the modules it imports into a
+ * single script body, and appends them to `dependencies`.
+ *
+ * Every module runs in its own function scope, after the modules it imports,
+ * and returns its exports as getters. Its imports become declarations
+ * reading them at the top of that scope. Modules loaded from absolute URLs
+ * are imported once at the top of the bundle.
+ *
  * @throws exception
  */
-static std::string inline_files(std::string data, const smatches &smatches,
+static std::string bundle_modules(const std::string &path,
+                                  std::vector<dependency> &dependencies) {
+    module_graph graph;
+    visit_module(
+        std::filesystem::path(path).lexically_normal().generic_string(), graph,
+        dependencies);
+
+    const std::regex import_regex(IMPORT_PATTERN);
+    const std::regex export_from_regex(EXPORT_FROM_PATTERN);
+    const std::regex export_list_regex(EXPORT_LIST_PATTERN);
+    const std::regex export_default_decl_regex(EXPORT_DEFAULT_DECL_PATTERN);
+    const std::regex export_default_regex(EXPORT_DEFAULT_PATTERN);
+    const std::regex export_decl_regex(EXPORT_DECL_PATTERN);
+    const std::regex export_regex(EXPORT_PATTERN);
+    const std::regex namespace_regex(NAMESPACE_PATTERN);
+    const std::regex name_regex(NAME_PATTERN);
+    std::map<std::string, js_module> bundled;
+    std::map<std::string, std::string> externals;
+    std::string imports;
+    std::string bundle;
+
+    for (size_t i = 0; i < graph.order.size(); ++i) {
+        const auto &module_path = graph.order[i];
+        auto source = graph.sources.at(module_path);
+        js_exports exports;
+        std::string bindings;
+
+        // The name holding the exports of `spec`, and the names it exports.
+        const auto get_module = [&](const std::string &spec)
+            -> std::pair<std::string, const std::vector<std::string> *> {
+            const auto dep = resolve_module(module_path, spec);
+
+            if (!dep.empty()) {
+                const auto &module = bundled.at(dep);
+                return {module.name, &module.exports};
+            }
+
+            const auto [iter, inserted] = externals.try_emplace(
+                spec, "__external_" + std::to_string(externals.size()));
+
+            if (inserted) {
+                imports += "import * as " + iter->second + " from \"" + spec +
+                           "\";\n";
+            }
+
+            return {iter->second, nullptr};
+        };
+
+        source = replace_matches(source, import_regex, [&](const auto &match) {
+            const auto [name, names] = get_module(match[4].str());
+            bindings += bind_imports(match[3].str(), name, names, module_path);
+            return match[1].str() + match[2].str();
+        });
+
+        source =
+            replace_matches(source, export_from_regex, [&](const auto &match) {
+                const auto clause = match[3].str();
+                const auto spec = match[4].str();
+                const auto [name, names] = get_module(spec);
+                std::smatch namespace_match;
+
+                if (clause == "*") {
+                    if (names == nullptr) {
+                        throw exception(
+                            "Failed to re-export all names of \"" + spec +
+                            "\": exported from " + module_path);
+                    }
+
+                    for (const auto &exported : *names) {
+                        if (exported != "default") {
+                            exports.emplace_back(exported,
+                                                 name + "." + exported);
+                        }
+                    }
+                } else if (std::regex_search(clause, namespace_match,
+                                             namespace_regex)) {
+                    exports.emplace_back(namespace_match[1].str(), name);
+                } else {
+                    for (std::sregex_iterator iter(clause.begin(),
+                                                   clause.end(), name_regex),
+                         end;
+                         iter != end; ++iter) {
+                        const auto imported = (*iter)[1].str();
+                        const auto exported = (*iter)[2].matched
+                                                  ? (*iter)[2].str()
+                                                  : imported;
+                        exports.emplace_back(
+                            exported,
+                            get_export(name, names, imported, module_path));
+                    }
+                }
+
+                return match[1].str() + match[2].str();
+            });
+
+        source =
+            replace_matches(source, export_list_regex, [&](const auto &match) {
+                const auto list = match[3].str();
+
+                for (std::sregex_iterator iter(list.begin(), list.end(),
+                                               name_regex),
+                     end;
+                     iter != end; ++iter) {
+                    const auto local = (*iter)[1].str();
+                    const auto exported =
+                        (*iter)[2].matched ? (*iter)[2].str() : local;
+                    exports.emplace_back(exported, local);
+                }
+
+                return match[1].str() + match[2].str();
+            });
+
+        source = replace_matches(
+            source, export_default_decl_regex, [&](const auto &match) {
+                const auto name =
+                    match[4].matched ? match[4].str() : match[5].str();
+                exports.emplace_back("default", name);
+                return match[1].str() + match[2].str() + match[3].str();
+            });
+
+        source = replace_matches(
+            source, export_default_regex, [&](const auto &match) {
+                exports.emplace_back("default", "__default");
+                return match[1].str() + match[2].str() + "const __default = ";
+            });
+
+        source =
+            replace_matches(source, export_decl_regex, [&](const auto &match) {
+                const auto keyword = trim(match[3].str());
+                exports.emplace_back(match[4].str(), match[4].str());
+
+                if (keyword == "const" || keyword == "let" ||
+                    keyword == "var") {
+                    const auto suffix = match.suffix();
+
+                    for (const auto &name :
+                         get_declarators(std::string_view(suffix.first,
+                                                          suffix.second),
+                                         module_path)) {
+                        exports.emplace_back(name, name);
+                    }
+                }
+
+                return match[1].str() + match[2].str() + match[3].str() +
+                       match[4].str();
+            });
+
+        if (std::regex_search(source, export_regex)) {
+            throw exception("Unsupported export declaration: " + module_path);
+        }
+
+        check_reassignments(source, exports, module_path);
+
+        auto &module = bundled[module_path];
+        module.name = "__module_" + std::to_string(i);
+        bundle += "const " + module.name + " = await (async () => {\n";
+
+        // Like imports, the bindings are initialized before the module runs.
+        if (!bindings.empty()) {
+            bundle += bindings + "\n";
+        }
+
+        bundle += source;
+
+        if (!source.empty() && source.back() != '\n') {
+            bundle += '\n';
+        }
+
+        bundle += "return {";
+
+        for (size_t j = 0; j < exports.size(); ++j) {
+            const auto &[exported, expression] = exports[j];
+            module.exports.push_back(exported);
+            bundle += std::string(j == 0 ? " " : ", ") + "get " + exported +
+                      "() { return " + expression + "; }";
+        }
+
+        bundle += exports.empty() ? "};\n})();\n" : " };\n})();\n";
+    }
+
+    return imports + bundle;
+}
+
+/**
+ * @throws exception
+ */
+static std::string inline_files(const std::string &data,
+                                const tag_matches &matches,
                                 const std::string_view dir,
-                                const std::string_view tag) {
-    for (auto iter = smatches.rbegin(); iter != smatches.rend(); ++iter) {
-        const auto pos = iter->position();
+                                const std::string_view tag,
+                                const options &opts,
+                                std::vector<dependency> &dependencies) {
+    const std::regex module_regex(MODULE_TYPE_PATTERN,
+                                  std::regex_constants::icase);
+    std::string result;
+    result.reserve(data.size());
+    size_t last = 0;
+
+    for (const auto &match : matches) {
         std::string content;
         size_t element_len;
 
         if (tag == SCRIPT_TAG) {
-            auto prefix_attrs = (*iter)[1].str();
-            const auto filename = (*iter)[2].str();
-            auto suffix_attrs = (*iter)[3].str();
-            const auto inner_content = (*iter)[4].str();
-            element_len = (*iter)[0].str().size();
+            auto prefix_attrs = match.groups[1].str();
+            const auto filename = match.groups[2].str();
+            auto suffix_attrs = match.groups[3].str();
+            const auto inner_content = match.groups[4].str();
+            element_len = match.groups[0].str().size();
             const auto path = dir.data() + filename;
 
             if (prefix_attrs == " ") {
@@ -133,19 +875,29 @@ static std::string inline_files(std::string data, const smatches &smatches,
                 suffix_attrs.clear();
             }
 
+            const auto is_module =
+                opts.bundle_modules &&
+                (std::regex_search(prefix_attrs, module_regex) ||
+                 std::regex_search(suffix_attrs, module_regex));
+
             try {
-                content = read_file(path);
+                if (is_module) {
+                    content = bundle_modules(path, dependencies);
+                } else {
+                    content = read_dependency(path, dependencies);
+                }
+
                 content = std::string("<script") + prefix_attrs + suffix_attrs +
                           ">" + content + "</script>";
             } catch (const std::ios::failure) {
                 throw exception("Failed to read file: " + path);
             }
         } else {
-            auto prefix_attrs = (*iter)[1].str();
-            auto middle_attrs = (*iter)[2].str();
-            const auto filename = (*iter)[3].str();
-            auto suffix_attrs = (*iter)[4].str();
-            element_len = (*iter)[0].str().size();
+            auto prefix_attrs = match.groups[1].str();
+            auto middle_attrs = match.groups[2].str();
+            const auto filename = match.groups[3].str();
+            auto suffix_attrs = match.groups[4].str();
+            element_len = match.groups[0].str().size();
             const auto path = dir.data() + filename;
 
             if (prefix_attrs == " ") {
@@ -161,7 +913,7 @@ static std::string inline_files(std::string data, const smatches &smatches,
             }
 
             try {
-                content = read_file(path);
+                content = read_dependency(path, dependencies);
                 content = "<style" + prefix_attrs + middle_attrs +
                           suffix_attrs + ">" + content + "</style>";
             } catch (const std::ios::failure) {
@@ -169,28 +921,36 @@ static std::string inline_files(std::string data, const smatches &smatches,
             }
         }
 
-        data.replace(pos, element_len, content);
+        result.append(data, last, match.position - last);
+        result.append(content);
+        last = match.position + element_len;
     }
 
-    return data;
+    result.append(data, last);
+    return result;
 }
 
+#ifdef _WIN32
 /**
  * @throws exception
  */
-static std::string inline_res(std::string data, const smatches &smatches,
-                              const res_map &map, const std::string_view tag) {
-    for (auto iter = smatches.rbegin(); iter != smatches.rend(); ++iter) {
-        const auto pos = iter->position();
+static std::string inline_res(const std::string &data,
+                              const tag_matches &matches, const res_map &map,
+                              const std::string_view tag) {
+    std::string result;
+    result.reserve(data.size());
+    size_t last = 0;
+
+    for (const auto &match : matches) {
         std::string content;
         size_t element_len;
 
         if (tag == SCRIPT_TAG) {
-            auto prefix_attrs = (*iter)[1].str();
-            const auto filename = (*iter)[2].str();
-            auto suffix_attrs = (*iter)[3].str();
-            const auto inner_content = (*iter)[4].str();
-            element_len = (*iter)[0].str().size();
+            auto prefix_attrs = match.groups[1].str();
+            const auto filename = match.groups[2].str();
+            auto suffix_attrs = match.groups[3].str();
+            const auto inner_content = match.groups[4].str();
+            element_len = match.groups[0].str().size();
 
             if (prefix_attrs == " ") {
                 prefix_attrs.clear();
@@ -213,11 +973,11 @@ static std::string inline_res(std::string data, const smatches &smatches,
                                 "System error: " + e.code().message());
             }
         } else {
-            auto prefix_attrs = (*iter)[1].str();
-            auto middle_attrs = (*iter)[2].str();
-            const auto filename = (*iter)[3].str();
-            auto suffix_attrs = (*iter)[4].str();
-            element_len = (*iter)[0].str().size();
+            auto prefix_attrs = match.groups[1].str();
+            auto middle_attrs = match.groups[2].str();
+            const auto filename = match.groups[3].str();
+            auto suffix_attrs = match.groups[4].str();
+            element_len = match.groups[0].str().size();
 
             if (prefix_attrs == " ") {
                 prefix_attrs.clear();
@@ -245,47 +1005,206 @@ static std::string inline_res(std::string data, const smatches &smatches,
             }
         }
 
-        data.replace(pos, element_len, content);
+        result.append(data, last, match.position - last);
+        result.append(content);
+        last = match.position + element_len;
     }
 
-    return data;
+    result.append(data, last);
+    return result;
 }
 
-static std::string remove_all_cr(std::string data) noexcept {
-    data.erase(std::remove(data.begin(), data.end(), '\r'), data.end());
-    return data;
+#endif  // _WIN32
+
+/**
+ * @brief Removes all `\r` from `data`, one chunk per thread.
+ *
+ * Each chunk counts its own `\r` first, so that every thread knows where its
+ * output starts before copying.
+ *
+ * @throws std::system_error
+ */
+static std::string remove_all_cr(const std::string &data,
+                                 const unsigned int threads) {
+    const auto bounds = get_chunk_bounds(data.size(), threads);
+    const auto count = bounds.size() - 1;
+    std::vector<size_t> offsets(count + 1);
+
+    run_chunks(count, [&](const size_t i) {
+        offsets[i + 1] = std::count_if(
+            data.begin() + bounds[i], data.begin() + bounds[i + 1],
+            [](const char c) { return c != '\r'; });
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    std::string result(offsets[count], '\0');
+
+    run_chunks(count, [&](const size_t i) {
+        std::remove_copy(data.begin() + bounds[i], data.begin() + bounds[i + 1],
+                         result.begin() + offsets[i], '\r');
+    });
+
+    return result;
 }
 
-std::string inline_html(const std::string_view path) {
-    auto directory = get_dir(path);
+/**
+ * @throws exception
+ * @throws std::system_error
+ */
+static std::string inline_document(std::string data,
+                                   const std::string_view dir,
+                                   const options &opts,
+                                   std::vector<dependency> &dependencies) {
+    const auto style_matches = get_matches(data, STYLE_PATTERN, opts.threads);
+    data = inline_files(data, style_matches, dir, STYLE_TAG, opts,
+                        dependencies);
 
-    try {
-        auto data = read_file(path);
+    const auto script_matches = get_matches(data, SCRIPT_PATTERN, opts.threads);
+    data = inline_files(data, script_matches, dir, SCRIPT_TAG, opts,
+                        dependencies);
 
-        const auto style_smatches = get_smatches(data, STYLE_PATTERN);
-        data = inline_files(data, style_smatches, directory, STYLE_TAG);
+    return remove_all_cr(data, opts.threads);
+}
 
-        const auto script_smatches = get_smatches(data, SCRIPT_PATTERN);
-        data = inline_files(data, script_smatches, directory, SCRIPT_TAG);
+std::string inline_html(const std::string_view path, const options &opts) {
+    const auto directory = get_dir(path);
+    std::vector<dependency> dependencies;
 
-        return remove_all_cr(data);
+    try {
+        return inline_document(read_file(path), directory, opts, dependencies);
     } catch (const std::ios::failure) {
         throw exception("Failed to read file: " + std::string(path));
+    } catch (const std::system_error &e) {
+        throw exception("Failed to start worker thread\n"
+                        "System error: " +
+                        e.code().message());
     }
 }
 
+#ifndef _WIN32
+/**
+ * @brief Returns the path of `path` independent of the working directory.
+ */
+static std::string get_canonical(const std::string_view path) noexcept {
+    std::error_code ec;
+    const auto canonical = std::filesystem::weakly_canonical(path, ec);
+
+    if (ec) {
+        return std::filesystem::absolute(path, ec).generic_string();
+    }
+
+    return canonical.generic_string();
+}
+
+static std::uint64_t hash_dependency(const std::string_view path,
+                                     const file_stats &stats,
+                                     const std::uint64_t seed) noexcept {
+    const std::uint64_t fields[] = {stats.size, stats.time};
+    const auto hash = shared_cache::hash(path, seed);
+
+    return shared_cache::hash(
+        std::string_view(reinterpret_cast<const char *>(fields),
+                         sizeof(fields)),
+        hash);
+}
+
+/**
+ * @brief Hashes the size and modification time of every file listed in
+ * `dependencies`, one path per line, without reading them.
+ */
+static std::uint64_t get_dependency_hash(
+    const std::string_view dependencies) noexcept {
+    auto hash = shared_cache::hash("");
+    size_t begin = 0;
+
+    while (begin < dependencies.size()) {
+        auto end = dependencies.find('\n', begin);
+        end = end == std::string_view::npos ? dependencies.size() : end;
+        const auto dependency = dependencies.substr(begin, end - begin);
+        hash = hash_dependency(dependency, get_stats(dependency), hash);
+        begin = end + 1;
+    }
+
+    return hash;
+}
+
+shared_cache::entry inline_html(const std::string_view path,
+                                shared_cache &cache, const options &opts) {
+    const auto directory = get_dir(path);
+    auto key = get_canonical(path);
+
+    // The options changing the output are part of the key.
+    if (opts.bundle_modules) {
+        key += "\nbundle_modules";
+    }
+
+    if (auto entry = cache.find(key)) {
+        if (get_dependency_hash(entry->dependencies()) == entry->dep_hash()) {
+            return std::move(*entry);
+        }
+    }
+
+    try {
+        std::vector<dependency> dependencies;
+        auto result = inline_document(
+            read_dependency(std::string(path), dependencies), directory, opts,
+            dependencies);
+        std::string dependency_list;
+        auto read_hash = shared_cache::hash("");
+
+        for (const auto &[dependency, stats] : dependencies) {
+            const auto canonical = get_canonical(dependency);
+
+            if (!dependency_list.empty()) {
+                dependency_list += '\n';
+            }
+
+            dependency_list += canonical;
+            read_hash = hash_dependency(canonical, stats, read_hash);
+        }
+
+        const auto dep_hash = get_dependency_hash(dependency_list);
+
+        // A file changed while being read may not match the stats stored
+        // along with it, so the document is only stored if none did.
+        if (dep_hash != read_hash) {
+            return shared_cache::entry(std::move(result));
+        }
+
+        if (auto entry =
+                cache.insert(key, dep_hash, dependency_list, result)) {
+            return std::move(*entry);
+        }
+
+        return shared_cache::entry(std::move(result));
+    } catch (const std::ios::failure &) {
+        throw exception("Failed to read file: " + std::string(path));
+    } catch (const std::system_error &e) {
+        throw exception("Failed to start worker thread\n"
+                        "System error: " +
+                        e.code().message());
+    }
+}
+#endif  // _WIN32
+
 #ifdef _WIN32
-std::string inline_html(const int id, const res_map &map) {
+std::string inline_html(const int id, const res_map &map,
+                        const options &opts) {
     try {
         auto data = read_res(id, RT_HTML);
 
-        const auto style_smatches = get_smatches(data, STYLE_PATTERN);
-        data = inline_res(data, style_smatches, map, STYLE_TAG);
+        const auto style_matches =
+            get_matches(data, STYLE_PATTERN, opts.threads);
+        data = inline_res(data, style_matches, map, STYLE_TAG);
 
-        const auto script_smatches = get_smatches(data, SCRIPT_PATTERN);
-        data = inline_res(data, script_smatches, map, SCRIPT_TAG);
+        const auto script_matches =
+            get_matches(data, SCRIPT_PATTERN, opts.threads);
+        data = inline_res(data, script_matches, map, SCRIPT_TAG);
 
-        return remove_all_cr(data);
+        return remove_all_cr(data, opts.threads);
     } catch (const std::system_error &e) {
         throw exception("Failed to read resource: " + std::to_string(id) +
                         "\n" + "System error: " + e.code().message());
@@ -0,0 +1,707 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 LaffeyNyaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _WIN32
+
+#include "inline_html/shared_cache.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "inline_html/exception.h"
+
+namespace inline_html {
+static constexpr std::uint64_t MAGIC = 0x6c6d74685f6e6c6b;
+static constexpr size_t MAX_PROCESSES = 128;
+static constexpr size_t PIN_WORDS = MAX_PROCESSES / 64;
+static constexpr size_t MAX_PROBES = 16;
+static constexpr size_t ALIGNMENT = 64;
+static constexpr int OPEN_RETRIES = 1000;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+static_assert(std::atomic<std::int32_t>::is_always_lock_free);
+
+/**
+ * @brief A process attached to the cache. `start_time` tells it apart from a
+ * later process reusing its ID.
+ */
+struct shared_process {
+    std::atomic<std::int32_t> pid;
+    std::atomic<std::uint64_t> start_time;
+};
+
+struct alignas(ALIGNMENT) shared_cache::header {
+    std::atomic<std::uint64_t> magic;
+    std::uint64_t slot_count;
+    std::uint64_t capacity;
+    pthread_mutex_t writer;
+    std::atomic<std::uint64_t> clock;
+    shared_process processes[MAX_PROCESSES];
+};
+
+/**
+ * @brief An index entry, followed in the data region by its key, its
+ * dependencies and its document. `seq` is odd while a writer changes the
+ * other fields, which are atomics only so that readers racing with it are
+ * defined behavior. `superseded` marks an older version of a key that could
+ * not be evicted because it is still pinned.
+ */
+struct alignas(ALIGNMENT) shared_cache::slot {
+    std::atomic<std::uint64_t> seq;
+    std::atomic<bool> used;
+    std::atomic<bool> superseded;
+    std::atomic<std::uint64_t> key_hash;
+    std::atomic<std::uint64_t> dep_hash;
+    std::atomic<std::uint64_t> offset;
+    std::atomic<std::uint64_t> key_size;
+    std::atomic<std::uint64_t> deps_size;
+    std::atomic<std::uint64_t> data_size;
+    std::atomic<std::uint64_t> last_used;
+    std::atomic<std::uint64_t> pins[PIN_WORDS];
+};
+
+static size_t align(const size_t size) noexcept {
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/**
+ * @brief The start time of the process `pid` in clock ticks since boot, or
+ * `0` if it is unknown.
+ */
+static std::uint64_t get_start_time(const std::int32_t pid) noexcept {
+    try {
+        std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+        std::string stat(std::istreambuf_iterator<char>(file), {});
+        const auto comm_end = stat.rfind(')');
+
+        if (comm_end == std::string::npos) {
+            return 0;
+        }
+
+        // The fields after the command name start with the third one, and
+        // the start time is the 22nd.
+        std::istringstream fields(stat.substr(comm_end + 1));
+        std::string field;
+
+        for (int i = 3; i < 22 && fields >> field; ++i) {
+        }
+
+        std::uint64_t start_time = 0;
+        fields >> start_time;
+        return start_time;
+    } catch (...) {
+        return 0;
+    }
+}
+
+static bool is_alive(const std::int32_t pid,
+                     const std::uint64_t start_time) noexcept {
+    if (kill(pid, 0) != 0 && errno != EPERM) {
+        return false;
+    }
+
+    const auto current = get_start_time(pid);
+    return start_time == 0 || current == 0 || current == start_time;
+}
+
+static std::string get_error_message(const int error = errno) {
+    return std::system_category().message(error);
+}
+
+shared_cache::entry::entry(std::string data) noexcept
+    : owned_(std::move(data)) {}
+
+shared_cache::entry::entry(shared_cache *cache, size_t slot,
+                           std::uint64_t dep_hash,
+                           std::string_view dependencies,
+                           std::string_view view) noexcept
+    : cache_(cache),
+      slot_(slot),
+      dep_hash_(dep_hash),
+      dependencies_(dependencies),
+      view_(view) {}
+
+shared_cache::entry::entry(entry &&other) noexcept
+    : cache_(std::exchange(other.cache_, nullptr)),
+      slot_(other.slot_),
+      dep_hash_(other.dep_hash_),
+      dependencies_(other.dependencies_),
+      view_(other.view_),
+      owned_(std::move(other.owned_)) {}
+
+shared_cache::entry &shared_cache::entry::operator=(entry &&other) noexcept {
+    if (this != &other) {
+        release();
+        cache_ = std::exchange(other.cache_, nullptr);
+        slot_ = other.slot_;
+        dep_hash_ = other.dep_hash_;
+        dependencies_ = other.dependencies_;
+        view_ = other.view_;
+        owned_ = std::move(other.owned_);
+    }
+
+    return *this;
+}
+
+shared_cache::entry::~entry() { release(); }
+
+std::string_view shared_cache::entry::view() const noexcept {
+    return cache_ == nullptr ? std::string_view(owned_) : view_;
+}
+
+std::string_view shared_cache::entry::dependencies() const noexcept {
+    return cache_ == nullptr ? std::string_view() : dependencies_;
+}
+
+std::uint64_t shared_cache::entry::dep_hash() const noexcept {
+    return cache_ == nullptr ? 0 : dep_hash_;
+}
+
+bool shared_cache::entry::shared() const noexcept { return cache_ != nullptr; }
+
+void shared_cache::entry::release() noexcept {
+    if (cache_ != nullptr) {
+        cache_->unpin(slot_);
+        cache_ = nullptr;
+    }
+}
+
+shared_cache::shared_cache(const std::string_view name, const size_t capacity,
+                           const size_t slots) {
+    const std::string shm_name(name);
+    auto created = true;
+    auto fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd == -1 && errno == EEXIST) {
+        created = false;
+        fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+    }
+
+    if (fd == -1) {
+        throw exception("Failed to open shared memory: " + shm_name + "\n" +
+                        "System error: " + get_error_message());
+    }
+
+    auto slot_count = std::max<size_t>(slots, 1);
+    auto data_capacity = capacity;
+
+    if (created) {
+        mapping_size_ = align(sizeof(header)) + slot_count * sizeof(slot) +
+                        data_capacity;
+
+        if (ftruncate(fd, static_cast<off_t>(mapping_size_)) == -1) {
+            const auto message = get_error_message();
+            close(fd);
+            shm_unlink(shm_name.c_str());
+            throw exception("Failed to resize shared memory: " + shm_name +
+                            "\n" + "System error: " + message);
+        }
+    } else {
+        auto ready = false;
+
+        for (int i = 0; i < OPEN_RETRIES && !ready; ++i) {
+            struct stat st;
+
+            if (fstat(fd, &st) == 0 &&
+                static_cast<size_t>(st.st_size) >= sizeof(header)) {
+                const auto existing = static_cast<header *>(mmap(
+                    nullptr, sizeof(header), PROT_READ, MAP_SHARED, fd, 0));
+
+                if (existing != MAP_FAILED) {
+                    if (existing->magic.load(std::memory_order_acquire) ==
+                        MAGIC) {
+                        slot_count = existing->slot_count;
+                        data_capacity = existing->capacity;
+                        mapping_size_ = static_cast<size_t>(st.st_size);
+                        ready = true;
+                    }
+
+                    munmap(existing, sizeof(header));
+                }
+            }
+
+            if (!ready) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        if (!ready) {
+            close(fd);
+            throw exception("Shared memory is not initialized: " + shm_name);
+        }
+    }
+
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+    read_only_mapping_ =
+        mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, fd, 0);
+    const auto message = get_error_message();
+    close(fd);
+
+    if (mapping_ == MAP_FAILED || read_only_mapping_ == MAP_FAILED) {
+        if (mapping_ != MAP_FAILED) {
+            munmap(mapping_, mapping_size_);
+        }
+
+        if (read_only_mapping_ != MAP_FAILED) {
+            munmap(const_cast<void *>(read_only_mapping_), mapping_size_);
+        }
+
+        throw exception("Failed to map shared memory: " + shm_name + "\n" +
+                        "System error: " + message);
+    }
+
+    header_ = static_cast<header *>(mapping_);
+
+    if (created) {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header_->writer, &attr);
+        pthread_mutexattr_destroy(&attr);
+
+        header_->slot_count = slot_count;
+        header_->capacity = data_capacity;
+        header_->magic.store(MAGIC, std::memory_order_release);
+    }
+
+    pins_.resize(slot_count);
+    auto registered = false;
+
+    if (lock()) {
+        reap_processes();
+
+        for (size_t i = 0; i < MAX_PROCESSES && !registered; ++i) {
+            auto &process = header_->processes[i];
+            std::int32_t expected = 0;
+
+            if (process.pid.compare_exchange_strong(expected, getpid())) {
+                process.start_time.store(get_start_time(getpid()));
+                process_ = i;
+                registered = true;
+            }
+        }
+
+        unlock();
+    }
+
+    if (!registered) {
+        munmap(mapping_, mapping_size_);
+        munmap(const_cast<void *>(read_only_mapping_), mapping_size_);
+        throw exception("Failed to attach to shared memory: " + shm_name);
+    }
+}
+
+shared_cache::~shared_cache() {
+    const auto mask = ~(std::uint64_t{1} << (process_ % 64));
+
+    for (size_t i = 0; i < header_->slot_count; ++i) {
+        get_slot(i).pins[process_ / 64].fetch_and(mask);
+    }
+
+    header_->processes[process_].start_time.store(0);
+    header_->processes[process_].pid.store(0);
+    munmap(mapping_, mapping_size_);
+    munmap(const_cast<void *>(read_only_mapping_), mapping_size_);
+}
+
+std::optional<shared_cache::entry> shared_cache::find(
+    const std::string_view key) {
+    const auto key_hash = hash(key);
+    const auto count = header_->slot_count;
+
+    for (size_t probe = 0; probe < std::min(MAX_PROBES, count); ++probe) {
+        const auto index = (key_hash + probe) % count;
+        auto &s = get_slot(index);
+
+        for (;;) {
+            const auto seq = s.seq.load(std::memory_order_acquire);
+
+            if (seq % 2 == 1 || !s.used.load(std::memory_order_relaxed) ||
+                s.superseded.load(std::memory_order_relaxed) ||
+                s.key_hash.load(std::memory_order_relaxed) != key_hash ||
+                s.key_size.load(std::memory_order_relaxed) != key.size()) {
+                break;
+            }
+
+            const auto dep_hash = s.dep_hash.load(std::memory_order_relaxed);
+            const auto offset = s.offset.load(std::memory_order_relaxed);
+            const auto deps_size = s.deps_size.load(std::memory_order_relaxed);
+            const auto data_size = s.data_size.load(std::memory_order_relaxed);
+
+            // Once pinned and still unchanged, no writer can touch the slot.
+            pin(index);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (s.seq.load() != seq) {
+                unpin(index);
+                continue;
+            }
+
+            const auto begin = get_read_only_data() + offset;
+
+            if (std::string_view(begin, key.size()) != key) {
+                unpin(index);
+                break;
+            }
+
+            s.last_used.store(header_->clock.fetch_add(1),
+                              std::memory_order_relaxed);
+            return entry(this, index, dep_hash,
+                         std::string_view(begin + key.size(), deps_size),
+                         std::string_view(begin + key.size() + deps_size,
+                                          data_size));
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<shared_cache::entry> shared_cache::insert(
+    const std::string_view key, const std::uint64_t dep_hash,
+    const std::string_view dependencies, const std::string_view data) {
+    const auto size = key.size() + dependencies.size() + data.size();
+
+    if (size > header_->capacity) {
+        return std::nullopt;
+    }
+
+    if (auto found = find(key); found && found->dep_hash() == dep_hash) {
+        return found;
+    }
+
+    const auto key_hash = hash(key);
+    const auto count = header_->slot_count;
+    std::optional<size_t> target;
+    std::optional<size_t> oldest;
+
+    if (!lock()) {
+        return std::nullopt;
+    }
+
+    for (size_t probe = 0; probe < std::min(MAX_PROBES, count); ++probe) {
+        const auto index = (key_hash + probe) % count;
+        auto &s = get_slot(index);
+
+        if (!s.used.load()) {
+            target = target.value_or(index);
+            continue;
+        }
+
+        const auto same_key =
+            s.key_hash.load() == key_hash && s.key_size.load() == key.size() &&
+            std::string_view(get_data() + s.offset.load(), key.size()) == key;
+
+        if (same_key && !s.superseded.load() &&
+            s.dep_hash.load() == dep_hash) {
+            auto found = get_entry(index);
+            unlock();
+            return found;
+        }
+
+        if (same_key && evict(index)) {
+            target = target.value_or(index);
+        } else if (same_key) {
+            supersede(index);
+        } else if (!pinned(index) &&
+                   (!oldest ||
+                    s.last_used.load() < get_slot(*oldest).last_used.load())) {
+            oldest = index;
+        }
+    }
+
+    if (!target && oldest && evict(*oldest)) {
+        target = oldest;
+    }
+
+    const auto offset = target ? allocate(size, *target) : std::nullopt;
+
+    if (!offset) {
+        unlock();
+        return std::nullopt;
+    }
+
+    auto &s = get_slot(*target);
+    const auto seq = s.seq.load();
+    s.seq.store(seq + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto begin = get_data() + *offset;
+    std::memcpy(begin, key.data(), key.size());
+    std::memcpy(begin + key.size(), dependencies.data(), dependencies.size());
+    std::memcpy(begin + key.size() + dependencies.size(), data.data(),
+                data.size());
+    s.key_hash.store(key_hash, std::memory_order_relaxed);
+    s.dep_hash.store(dep_hash, std::memory_order_relaxed);
+    s.offset.store(*offset, std::memory_order_relaxed);
+    s.key_size.store(key.size(), std::memory_order_relaxed);
+    s.deps_size.store(dependencies.size(), std::memory_order_relaxed);
+    s.data_size.store(data.size(), std::memory_order_relaxed);
+    s.last_used.store(header_->clock.fetch_add(1), std::memory_order_relaxed);
+    s.superseded.store(false, std::memory_order_relaxed);
+    s.used.store(true, std::memory_order_relaxed);
+    s.seq.store(seq + 2, std::memory_order_release);
+
+    auto inserted = get_entry(*target);
+    unlock();
+    return inserted;
+}
+
+void shared_cache::remove(const std::string_view name) noexcept {
+    shm_unlink(std::string(name).c_str());
+}
+
+std::uint64_t shared_cache::hash(const std::string_view data,
+                                 const std::uint64_t seed) noexcept {
+    auto hash = seed;
+
+    for (const auto c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+shared_cache::slot &shared_cache::get_slot(const size_t index) const noexcept {
+    const auto slots =
+        reinterpret_cast<slot *>(static_cast<char *>(mapping_) +
+                                 align(sizeof(header)));
+    return slots[index];
+}
+
+char *shared_cache::get_data() const noexcept {
+    return static_cast<char *>(mapping_) + align(sizeof(header)) +
+           header_->slot_count * sizeof(slot);
+}
+
+const char *shared_cache::get_read_only_data() const noexcept {
+    return static_cast<const char *>(read_only_mapping_) +
+           align(sizeof(header)) + header_->slot_count * sizeof(slot);
+}
+
+/**
+ * @brief Pins the slot `index` and returns its document. Only called while
+ * holding the writer lock, so that the slot cannot change in between.
+ */
+shared_cache::entry shared_cache::get_entry(const size_t index) noexcept {
+    auto &s = get_slot(index);
+    const auto key_size = s.key_size.load();
+    const auto deps_size = s.deps_size.load();
+    const auto begin = get_read_only_data() + s.offset.load() + key_size;
+
+    pin(index);
+    s.last_used.store(header_->clock.fetch_add(1), std::memory_order_relaxed);
+    return entry(this, index, s.dep_hash.load(),
+                 std::string_view(begin, deps_size),
+                 std::string_view(begin + deps_size, s.data_size.load()));
+}
+
+void shared_cache::pin(const size_t index) noexcept {
+    std::lock_guard lock(pins_mutex_);
+
+    if (pins_[index]++ == 0) {
+        get_slot(index).pins[process_ / 64].fetch_or(std::uint64_t{1}
+                                                     << (process_ % 64));
+    }
+}
+
+void shared_cache::unpin(const size_t index) noexcept {
+    std::lock_guard lock(pins_mutex_);
+
+    if (--pins_[index] == 0) {
+        get_slot(index).pins[process_ / 64].fetch_and(
+            ~(std::uint64_t{1} << (process_ % 64)));
+    }
+}
+
+bool shared_cache::pinned(const size_t index) const noexcept {
+    const auto &pins = get_slot(index).pins;
+
+    return std::any_of(std::begin(pins), std::end(pins),
+                       [](const auto &word) { return word.load() != 0; });
+}
+
+/**
+ * @brief Blocks until this process is the only writer.
+ *
+ * @return bool Whether the lock was taken. It is not if locking fails for
+ * another reason than a dead owner, e.g. `ENOTRECOVERABLE` if a process
+ * outside this class unlocked the mutex without making it consistent. A
+ * process dying before it does here leaves `EOWNERDEAD` to the next one.
+ */
+bool shared_cache::lock() noexcept {
+    const auto result = pthread_mutex_lock(&header_->writer);
+
+    // The owner died holding the lock, so its writes may be partial.
+    if (result == EOWNERDEAD) {
+        recover();
+        pthread_mutex_consistent(&header_->writer);
+        return true;
+    }
+
+    return result == 0;
+}
+
+void shared_cache::unlock() noexcept { pthread_mutex_unlock(&header_->writer); }
+
+void shared_cache::recover() noexcept {
+    for (size_t i = 0; i < header_->slot_count; ++i) {
+        auto &s = get_slot(i);
+        const auto seq = s.seq.load();
+
+        if (seq % 2 == 1) {
+            s.used.store(false);
+            s.seq.store(seq + 1);
+        }
+    }
+
+    reap_processes();
+}
+
+void shared_cache::reap_processes() noexcept {
+    for (size_t i = 0; i < MAX_PROCESSES; ++i) {
+        auto &process = header_->processes[i];
+        const auto pid = process.pid.load();
+
+        if (pid == 0 || is_alive(pid, process.start_time.load())) {
+            continue;
+        }
+
+        const auto mask = ~(std::uint64_t{1} << (i % 64));
+
+        for (size_t j = 0; j < header_->slot_count; ++j) {
+            get_slot(j).pins[i / 64].fetch_and(mask);
+        }
+
+        process.start_time.store(0);
+        process.pid.store(0);
+    }
+}
+
+bool shared_cache::evict(const size_t index) noexcept {
+    auto &s = get_slot(index);
+    const auto seq = s.seq.load();
+    s.seq.store(seq + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (pinned(index)) {
+        s.seq.store(seq + 2);
+        return false;
+    }
+
+    s.used.store(false);
+    s.seq.store(seq + 2, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Hides the slot `index` from `find` while its readers still hold it,
+ * so that it is evicted once they release it instead of being found again.
+ */
+void shared_cache::supersede(const size_t index) noexcept {
+    auto &s = get_slot(index);
+    const auto seq = s.seq.load();
+    s.seq.store(seq + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.superseded.store(true);
+    s.seq.store(seq + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Finds the first gap of `size` bytes between the stored documents,
+ * evicting the least recently used ones until there is one.
+ */
+std::optional<size_t> shared_cache::allocate(const size_t size,
+                                             const size_t target) noexcept {
+    auto reaped = false;
+
+    for (;;) {
+        std::vector<std::pair<size_t, size_t>> extents;
+        std::optional<size_t> oldest;
+
+        for (size_t i = 0; i < header_->slot_count; ++i) {
+            const auto &s = get_slot(i);
+
+            if (i == target || !s.used.load()) {
+                continue;
+            }
+
+            const auto offset = s.offset.load();
+            extents.emplace_back(offset, offset + s.key_size.load() +
+                                             s.deps_size.load() +
+                                             s.data_size.load());
+
+            if (!pinned(i) &&
+                (!oldest ||
+                 s.last_used.load() < get_slot(*oldest).last_used.load())) {
+                oldest = i;
+            }
+        }
+
+        std::sort(extents.begin(), extents.end());
+        size_t gap = 0;
+
+        for (const auto &[begin, end] : extents) {
+            if (begin - gap >= size) {
+                return gap;
+            }
+
+            gap = std::max(gap, end);
+        }
+
+        if (header_->capacity - gap >= size) {
+            return gap;
+        }
+
+        if (oldest) {
+            evict(*oldest);
+        } else if (!reaped) {
+            reap_processes();
+            reaped = true;
+        } else {
+            return std::nullopt;
+        }
+    }
+}
+}  // namespace inline_html
+
+#endif  // _WIN32
@@ -0,0 +1,3 @@
+import _ from "lodash";
+
+console.log(_);
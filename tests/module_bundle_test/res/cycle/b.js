@@ -0,0 +1,3 @@
+import { a } from "./main.js";
+
+export const b = () => a;
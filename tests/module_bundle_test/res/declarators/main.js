@@ -0,0 +1,3 @@
+import { a } from "./lib.js";
+
+console.log(a);
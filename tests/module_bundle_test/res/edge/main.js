@@ -0,0 +1,5 @@
+console.log(d);
+import d from "./y.js";import {x, w} from "./x.js";
+import { default as z, cdn } from "./reexport.js";
+
+console.log(d, x, w, z, cdn);
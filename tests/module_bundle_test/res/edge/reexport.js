@@ -0,0 +1,2 @@
+export { default } from "./y.js";
+export * from "./x.js";
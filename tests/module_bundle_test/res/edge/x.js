@@ -0,0 +1,4 @@
+const helper = () => "x";
+export const x = helper(), w = [helper(), "w"].join(""),
+    v = "v";
+export { cdn } from "https://cdn.example.com/x.js";
@@ -0,0 +1,3 @@
+const helper = () => "y";
+const functional = helper();
+export default functional;
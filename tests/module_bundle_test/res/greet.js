@@ -0,0 +1,5 @@
+import { add } from "./lib/math.js";
+
+export default function greet(name) {
+    return "Hello, " + name + add(0, 1);
+}
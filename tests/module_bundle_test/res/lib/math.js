@@ -0,0 +1,5 @@
+export function add(a, b) {
+    return a + b;
+}
+
+export const square = (x) => x * x;
@@ -0,0 +1,4 @@
+import { count, inc } from "./counter.js";
+
+inc();
+console.log(count);
@@ -0,0 +1,4 @@
+import { add, square as sq } from "./lib/math.js";
+import greet from "./greet.js";
+
+console.log(greet("world"), add(1, sq(2)));
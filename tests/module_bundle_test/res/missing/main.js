@@ -0,0 +1,3 @@
+import { x } from "./nope.js";
+
+console.log(x);
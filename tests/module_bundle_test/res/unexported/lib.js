@@ -0,0 +1 @@
+export const yes = 1;
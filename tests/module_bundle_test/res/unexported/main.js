@@ -0,0 +1,3 @@
+import { nope } from "./lib.js";
+
+console.log(nope);
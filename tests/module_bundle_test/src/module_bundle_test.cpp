@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 LaffeyNyaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <inline_html/exception.h>
+#include <inline_html/inline_html.h>
+
+#include <iostream>
+#include <string>
+#include <utility>
+
+static const std::pair<std::string, std::string> TEST_SAMPLES[] = {
+    {"res/index.html", R"delimiter(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <script type="module" >const __module_0 = await (async () => {
+function add(a, b) {
+    return a + b;
+}
+
+const square = (x) => x * x;
+return { get add() { return add; }, get square() { return square; } };
+})();
+const __module_1 = await (async () => {
+const add = __module_0.add;
+;
+
+function greet(name) {
+    return "Hello, " + name + add(0, 1);
+}
+return { get default() { return greet; } };
+})();
+const __module_2 = await (async () => {
+const add = __module_0.add;const sq = __module_0.square;const greet = __module_1.default;
+;
+;
+
+console.log(greet("world"), add(1, sq(2)));
+return {};
+})();
+</script>
+    <title>Document</title>
+</head>
+<body>
+</body>
+</html>
+)delimiter"},
+    // Minified imports, re-exports, private names declared by several
+    // modules and a re-export of a module loaded from an absolute URL.
+    {"res/edge.html", R"delimiter(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <script type="module" >import * as __external_0 from "https://cdn.example.com/x.js";
+const __module_0 = await (async () => {
+const helper = () => "y";
+const functional = helper();
+const __default = functional;
+return { get default() { return __default; } };
+})();
+const __module_1 = await (async () => {
+const helper = () => "x";
+const x = helper(), w = [helper(), "w"].join(""),
+    v = "v";
+;
+return { get cdn() { return __external_0.cdn; }, get x() { return x; }, get w() { return w; }, get v() { return v; } };
+})();
+const __module_2 = await (async () => {
+;
+;
+return { get default() { return __module_0.default; }, get cdn() { return __module_1.cdn; }, get x() { return __module_1.x; }, get w() { return __module_1.w; }, get v() { return __module_1.v; } };
+})();
+const __module_3 = await (async () => {
+const d = __module_0.default;const x = __module_1.x;const w = __module_1.w;const z = __module_2.default;const cdn = __module_2.cdn;
+console.log(d);
+;;
+;
+
+console.log(d, x, w, z, cdn);
+return {};
+})();
+</script>
+    <title>Document</title>
+</head>
+<body>
+</body>
+</html>
+)delimiter"},
+};
+
+static const std::pair<std::string, std::string> FAILING_PATHS[] = {
+    {"res/cycle.html", "Circular module import"},
+    {"res/missing.html", "Failed to resolve module"},
+    {"res/bare.html", "Unresolvable module specifier"},
+    {"res/unexported.html", "Module does not export"},
+    {"res/live.html", "is reassigned"},
+    {"res/declarators.html", "Unsupported export declaration"},
+};
+
+int main() {
+    for (const auto &[path, sample] : TEST_SAMPLES) {
+        try {
+            const auto html_data =
+                inline_html::inline_html(path, {.bundle_modules = true});
+
+            if (html_data != sample) {
+                std::cerr << html_data << "\n";
+                return 1;
+            }
+        } catch (const inline_html::exception &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    for (const auto &[path, message] : FAILING_PATHS) {
+        try {
+            inline_html::inline_html(path, {.bundle_modules = true});
+            std::cerr << "No exception for " << path << "\n";
+            return 1;
+        } catch (const inline_html::exception &e) {
+            if (std::string(e.what()).find(message) == std::string::npos) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
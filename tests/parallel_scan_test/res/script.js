@@ -0,0 +1,5 @@
+// For demo
+
+function showAlert() {
+    alert("You cliked me!");
+}
@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 LaffeyNyaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <inline_html/exception.h>
+#include <inline_html/inline_html.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static const std::string TEST_PATH = "res/large.html";
+static const unsigned int THREAD_COUNTS[] = {0, 2, 3, 4, 8};
+
+/**
+ * @brief Builds a document of a few MiB whose tags and `<script>` bodies
+ * land on many different offsets, so that some of them straddle the chunk
+ * boundaries of the parallel scan. The merged matches must equal those of a
+ * sequential scan.
+ */
+static std::string make_document() {
+    std::string data = "<!DOCTYPE html>\r\n<html>\r\n<head>\r\n";
+
+    for (size_t i = 0; i < 2000; ++i) {
+        data += std::string(i % 97, ' ');
+        data += "<link rel=\"stylesheet\" href=\"style.css\">\r\n";
+        data += "<link\r\n    rel=\"stylesheet\"\r\n    href=\"style.css\">\r\n";
+        data += "<!-- <script src=\"script.js\"></script> -->\r\n";
+        data += "<script type=\"text/javascript\" src=\"script.js\"></script>";
+        data += "\r\n";
+
+        if (i % 7 == 0) {
+            data += "<script src=\"script.js\">" +
+                    std::string(4096 + i, 'x') + "</script>\r\n";
+        }
+    }
+
+    data += "</head>\r\n<body></body>\r\n</html>\r\n";
+    return data;
+}
+
+int main() {
+    try {
+        std::ofstream(TEST_PATH, std::ios::binary) << make_document();
+
+        const auto expected =
+            inline_html::inline_html(TEST_PATH, {.threads = 1});
+
+        if (expected.find('\r') != std::string::npos) {
+            return 1;
+        }
+
+        for (const auto threads : THREAD_COUNTS) {
+            const auto html_data =
+                inline_html::inline_html(TEST_PATH, {.threads = threads});
+
+            if (html_data != expected) {
+                std::cerr << "Mismatch with " << threads << " threads\n";
+                return 1;
+            }
+        }
+    } catch (const inline_html::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
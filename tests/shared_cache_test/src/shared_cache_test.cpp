@@ -0,0 +1,216 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 LaffeyNyaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <inline_html/exception.h>
+#include <inline_html/inline_html.h>
+#include <inline_html/shared_cache.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static const std::string TEST_PATH = "res/index.html";
+static const std::string STALE_PATH = "res/stale.html";
+static const std::string CACHE_NAME =
+    "/inline_html_test_" + std::to_string(getpid());
+
+/**
+ * @brief Runs `func` in a child process, which must end it with `_exit()` so
+ * that nothing it holds is released.
+ *
+ * @return int The exit code of the child process, or `-1` if it was killed.
+ */
+template <typename Func>
+static int run_child(Func &&func) {
+    const auto pid = fork();
+
+    if (pid == 0) {
+        func();
+        _exit(1);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void write_file(const std::string &path, const std::string &data) {
+    std::ofstream(path, std::ios::binary) << data;
+}
+
+static bool test_sharing() {
+    const auto expected = inline_html::inline_html(TEST_PATH);
+    inline_html::shared_cache cache(CACHE_NAME, 1024 * 1024);
+    const auto first = inline_html::inline_html(TEST_PATH, cache);
+    const auto second = inline_html::inline_html(TEST_PATH, cache);
+
+    return first.shared() && first.view() == expected &&
+           second.view().data() == first.view().data();
+}
+
+static bool test_working_directory() {
+    const auto key =
+        std::filesystem::weakly_canonical(TEST_PATH).generic_string();
+    size_t size = 0;
+
+    {
+        inline_html::shared_cache cache(CACHE_NAME, 1024 * 1024);
+        const auto entry = inline_html::inline_html(TEST_PATH, cache);
+        size = key.size() + entry.dependencies().size() + entry.view().size();
+    }
+
+    inline_html::shared_cache::remove(CACHE_NAME);
+
+    // The cache only has room for the pinned document, so another process
+    // only gets a shared entry if it finds that one.
+    inline_html::shared_cache cache(CACHE_NAME, size);
+    const auto entry = inline_html::inline_html(TEST_PATH, cache);
+
+    const auto code = run_child([&]() {
+        std::filesystem::current_path("res");
+        inline_html::shared_cache child_cache(CACHE_NAME, 0);
+        const auto found = inline_html::inline_html("index.html", child_cache);
+        _exit(found.shared() && found.view() == entry.view() ? 0 : 1);
+    });
+
+    return entry.shared() && code == 0;
+}
+
+static bool test_dependencies() {
+    write_file(STALE_PATH,
+               "<link rel=\"stylesheet\" href=\"stale.css\">\n"
+               "<script type=\"module\" src=\"stale.js\"></script>\n");
+    write_file("res/stale.css", "p { color: red; }");
+    write_file("res/stale.js", "import { text } from \"./stale_dep.js\";\n");
+    write_file("res/stale_dep.js", "export const text = \"old\";\n");
+
+    inline_html::shared_cache cache(CACHE_NAME, 1024 * 1024);
+    const inline_html::options opts{.bundle_modules = true};
+    const auto contains = [&](const std::string_view text) {
+        return inline_html::inline_html(STALE_PATH, cache, opts).view().find(
+                   text) != std::string_view::npos;
+    };
+
+    // Holding the first version keeps it from being evicted, which must not
+    // make it found again once replaced.
+    const auto held = inline_html::inline_html(STALE_PATH, cache, opts);
+
+    if (held.view().find("\"old\"") == std::string_view::npos) {
+        return false;
+    }
+
+    write_file("res/stale_dep.js", "export const text = \"newer\";\n");
+
+    const auto key =
+        std::filesystem::weakly_canonical(STALE_PATH).generic_string() +
+        "\nbundle_modules";
+
+    if (!contains("\"newer\"") || !contains("\"newer\"") ||
+        cache.find(key)->dep_hash() == held.dep_hash()) {
+        return false;
+    }
+
+    write_file("res/stale.css", "p { color: blue; }");
+
+    return contains("blue") && contains("blue") &&
+           held.view().find("\"old\"") != std::string_view::npos;
+}
+
+static bool test_eviction() {
+    inline_html::shared_cache cache(CACHE_NAME, 64, 4);
+    const std::string data(40, 'x');
+
+    {
+        const auto first = cache.insert("first", 1, "", data);
+
+        // The pinned entry cannot make room for another one.
+        if (!first || cache.insert("second", 1, "", data)) {
+            return false;
+        }
+    }
+
+    if (!cache.insert("second", 1, "", data) || cache.find("first") ||
+        cache.insert("too large", 1, "", std::string(100, 'x'))) {
+        return false;
+    }
+
+    // A process dying with an entry pinned does not keep it forever.
+    const auto code = run_child([&]() {
+        inline_html::shared_cache child_cache(CACHE_NAME, 0);
+        const auto entry = child_cache.find("second");
+        const auto blocked = !child_cache.insert("third", 1, "", data);
+        _exit(entry && blocked ? 0 : 1);
+    });
+
+    return code == 0 && cache.insert("third", 1, "", data) &&
+           !cache.find("second");
+}
+
+static bool test_writer_death() {
+    inline_html::shared_cache cache(CACHE_NAME, 64, 4);
+
+    // The child crashes while copying the document, holding the writer lock
+    // and leaving its slot half-written.
+    const auto code = run_child([&]() {
+        inline_html::shared_cache child_cache(CACHE_NAME, 0);
+        const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const auto pages = static_cast<char *>(mmap(nullptr, 2 * page,
+                                                    PROT_READ | PROT_WRITE,
+                                                    MAP_PRIVATE | MAP_ANONYMOUS,
+                                                    -1, 0));
+        mprotect(pages + page, page, PROT_NONE);
+        child_cache.insert("crash", 1, "",
+                           std::string_view(pages + page - 20, 40));
+        _exit(0);
+    });
+
+    const std::string data(40, 'x');
+
+    return code == -1 && !cache.find("crash") &&
+           cache.insert("crash", 1, "", data) && cache.find("crash");
+}
+
+int main() {
+    auto passed = true;
+
+    for (const auto test : {test_sharing, test_working_directory,
+                            test_dependencies, test_eviction,
+                            test_writer_death}) {
+        inline_html::shared_cache::remove(CACHE_NAME);
+
+        try {
+            passed = passed && test();
+        } catch (const inline_html::exception &e) {
+            std::cerr << e.what() << "\n";
+            passed = false;
+        }
+    }
+
+    inline_html::shared_cache::remove(CACHE_NAME);
+    return passed ? 0 : 1;
+}